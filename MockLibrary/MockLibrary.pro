@@ -0,0 +1,29 @@
+###################################################################### ##
+## Filename: MockLibrary.pro
+## Author: Matthew Mendoza (MM)
+##
+## Builds the mocks shared by every Test* project once, as a static
+## library. Test projects pick it up through mocklibrary.pri.
+###################################################################### ##
+
+QT       += testlib
+QT       -= gui
+
+TARGET = mocks
+CONFIG   += staticlib
+CONFIG   -= app_bundle
+
+TEMPLATE = lib
+
+include($$PWD/../buildprofiles.pri)
+include($$PWD/mocklibrary.pri)
+
+DESTDIR = $$MOCKLIBRARY_DIR
+
+HEADERS += \
+    $$PWD/../../mocks/BaseSharedMemory_A/basesharedmemory_a.h \
+    $$PWD/../../mocks/BitTests/coriolisconfigurationtest.h \
+    $$PWD/../../mocks/mockhealthstatuslogger.h \
+    
+
+QMAKE_CXXFLAGS += -std=c++0x
@@ -0,0 +1,33 @@
+###################################################################### ##
+## Filename: mocklibrary.pri
+## Author: Matthew Mendoza (MM)
+##
+## Include from a Test* project to compile against the shared mocks:
+##     include($$PWD/../buildprofiles.pri)
+##     include($$PWD/../MockLibrary/mocklibrary.pri)
+## runTests.sh builds MockLibrary.pro before any test project.
+###################################################################### ##
+
+## One library per build profile (see buildprofiles.pri)
+coverage {
+    MOCKLIBRARY_DIR = $$PWD/build
+} else {
+    MOCKLIBRARY_DIR = $$PWD/build-$$BUILD_PROFILE
+}
+
+INCLUDEPATH += \
+    $$PWD/../../mocks \
+    $$PWD/../../mocks/BitTests \
+    $$PWD/../../mocks/HealthStatusLogger \
+
+## The mocks are compiled once, so every project has to agree on these.
+DEFINES += APPLICATION_LOGFILE_PATH=\\\"./\\\"  ## The logfile location on disk.
+DEFINES += private=public protected=public
+
+CONFIG += precompile_header
+PRECOMPILED_HEADER = $$PWD/mocklibrary_pch.h
+
+equals(TEMPLATE, app) {
+    LIBS += -L$$MOCKLIBRARY_DIR -lmocks
+    PRE_TARGETDEPS += $$MOCKLIBRARY_DIR/libmocks.a
+}
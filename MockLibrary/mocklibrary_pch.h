@@ -0,0 +1,16 @@
+/* **********************************************************************
+Author- Matthew Mendoza
+**
+** Precompiled header shared by MockLibrary and the Test* projects.
+** Only stable headers belong here; the class under test does not.
+********************************************************************** */
+#if defined __cplusplus
+#include <QtTest>
+
+#include <builder.h>
+#include <functionthread.h>
+#include <mockcommands.h>
+#include <mockhealthstatuslogger.h>
+#include <mocktest.h>
+#include <BaseSharedMemory_A/basesharedmemory_a.h>
+#endif
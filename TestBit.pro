@@ -12,28 +12,14 @@ CONFIG   -= app_bundle
 
 TEMPLATE = app
 
-INCLUDEPATH += \
-    $$PWD/../../mocks \
-    $$PWD/../../mocks/BitTests \
-    $$PWD/../../mocks/HealthStatusLogger \
+include($$PWD/../buildprofiles.pri)
+
+## Mocks, their include paths and the precompiled header come prebuilt
+include($$PWD/../MockLibrary/mocklibrary.pri)
 
 SOURCES += \
     $$PWD/tst_testbit.cpp \
 
-HEADERS += \
-    $$PWD/../../mocks/BaseSharedMemory_A/basesharedmemory_a.h \
-    $$PWD/../../mocks/BitTests/coriolisconfigurationtest.h \
-    $$PWD/../../mocks/mockhealthstatuslogger.h \
-    
-
-DEFINES += SRCDIR=\\\"$$PWD/\\\" \
-           APPLICATION_LOGFILE_PATH=\\\"./\\\" \  ## The logfile location on disk.
-           private=public protected=public
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 QMAKE_CXXFLAGS += -std=c++0x
-
-#For Code Coverage Analysis:
-QMAKE_CXXFLAGS += -g -Wall -fprofile-arcs -ftest-coverage -O0
-QMAKE_LFLAGS += -g -Wall -fprofile-arcs -ftest-coverage  -O0
-LIBS += \
-    -lgcov
@@ -0,0 +1,36 @@
+###################################################################### ##
+## Filename: buildprofiles.pri
+## Author: Matthew Mendoza (MM)
+##
+## Compiler settings shared by MockLibrary and every Test* project.
+## Pick one with CONFIG+=<profile> (runTests.sh -profile=<profile>):
+##     coverage - unoptimized, gcov instrumented (default)
+##     fast     - optimized, no instrumentation; quickest pass/fail run
+##     perf     - optimized with frame pointers, for benchmarks/profiling
+###################################################################### ##
+
+fast {
+    BUILD_PROFILE = fast
+} else:perf {
+    BUILD_PROFILE = perf
+} else {
+    BUILD_PROFILE = coverage
+    CONFIG += coverage
+}
+
+coverage {
+    #For Code Coverage Analysis:
+    QMAKE_CXXFLAGS += -g -Wall -fprofile-arcs -ftest-coverage -O0
+    QMAKE_LFLAGS += -g -Wall -fprofile-arcs -ftest-coverage  -O0
+    LIBS += \
+        -lgcov
+}
+
+fast {
+    QMAKE_CXXFLAGS += -Wall -O2
+}
+
+perf {
+    QMAKE_CXXFLAGS += -g -Wall -O2 -fno-omit-frame-pointer
+    QMAKE_LFLAGS += -g
+}
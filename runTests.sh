@@ -4,7 +4,38 @@
 # This is a script to run all the Qt Unit tests in this directory.
 #
 # It goes to each directory in this folder which begins with "Test",
-# and builds and runs the test project in that folder.
+# and builds and runs the test project in that folder. The shared mocks in
+# MockLibrary are built first, then linked by every project. Projects are built
+# and run concurrently, one project per core (override with -j<N>); each
+# project's output goes to UnitTestReports/logs/<project>.log.
+#
+# With -incremental, a project is only rebuilt and rerun when one of its
+# inputs changed since it last passed: its .pro file, the SOURCES and
+# HEADERS it lists, and every header they include from its INCLUDEPATH.
+# Unchanged projects report their cached result, and the xunit report and
+# tracefile saved with that result (.testcache/<profile>/) are put back, so
+# runs in between cannot swap in reports from different inputs.
+#
+# -profile=<name> picks the build profile from buildprofiles.pri:
+#   coverage (default) - instrumented build, followed by gcov code coverage
+#                        analysis
+#   fast               - optimized build, pass/fail only
+#   perf               - optimized build with frame pointers; also saves
+#                        QtTest benchmark results next to the reports
+# Projects marked CONFIG += benchmark in their .pro only run under perf.
+#
+# With -shard, every test function (and every row of a data-driven one) of
+# a suite runs as a separate process, several at a time. This is a process
+# pool, not an in-process runner: each shard is a full run of the suite's
+# executable restricted to one function or row. The shards' xunit reports
+# are merged into a single <testsuite> for the suite, with initTestCase and
+# cleanupTestCase reported once and the counters summed. A shard that
+# crashes before writing its report shows up as an error testcase named
+# after its function/row. Each shard starts from a fresh process, so it
+# gets its own Builder, mocks and MockTest::monitor.
+# Suites that share state outside the process (log files, fixtures on
+# disk) opt out with CONFIG += no_shard. Benchmarks (-profile=perf) are
+# never sharded.
 #
 # After running the tests, it uses gcov to perform code coverage analysis
 
@@ -20,6 +51,12 @@ done;
 declare -a FAILED_BUILD_TESTS
 declare -a FAILED_RUN_TESTS
 
+#Number of projects built and run at the same time
+MAX_JOBS=$(nproc)
+
+#Build profile, see buildprofiles.pri
+PROFILE=coverage
+
 #Command Line Args
 declare -A filter
 for arg in "$@"
@@ -28,6 +65,22 @@ do
         -xml) #Unit test output will be in xml
             XML_OUTPUT=YES
         ;;
+        -j*) #Limit the number of concurrent projects
+            if [[ ${arg:2} =~ ^[1-9][0-9]*$ ]] ; then
+                MAX_JOBS=${arg:2}
+            else
+                echo "Unrecognized Argument: $arg"
+            fi
+        ;;
+        -incremental) #Skip projects whose inputs have not changed
+            INCREMENTAL=YES
+        ;;
+        -profile=*) #Select the build profile
+            PROFILE=${arg#-profile=}
+        ;;
+        -shard) #Split each suite into one process per test function/row
+            SHARD=YES
+        ;;
         *) #Run specific tests instead of all tests
             if [[ ${TESTS_TO_RUN[$arg]} ]] ; then
                 filter["$arg"]="${TESTS_TO_RUN[$arg]}"
@@ -49,108 +102,598 @@ if [[ ${#filter[@]} -ge 1 ]] ; then
     done
 fi
 
+case $PROFILE in
+    coverage)
+        BUILD_DIR=build
+        QMAKE_CONFIG="CONFIG+=coverage CONFIG+=debug CONFIG+=declarative_debug"
+    ;;
+    fast|perf)
+        BUILD_DIR=build-$PROFILE
+        QMAKE_CONFIG="CONFIG+=$PROFILE CONFIG+=release"
+    ;;
+    *)
+        echo "Unrecognized Profile: $PROFILE"
+        exit 1
+    ;;
+esac
+
 # ensure reports directory exists
 mkdir -p $SCRIPT_DIR/UnitTestReports
+mkdir -p $SCRIPT_DIR/UnitTestReports/logs
+
+# print the .pro file followed by every .pri file it includes
+function profiles()
+{
+  echo $1
+  for PRI in $(sed -n -E 's/^\s*include\s*\(\s*([^)]*[^) ])\s*\).*/\1/p' $1 | sed -e 's|\$\$PWD|'"$(dirname $1)"'|g'); do
+    if [ -f "$PRI" ]; then
+      profiles $(realpath $PRI)
+    fi
+  done
+}
+
+# print the values assigned to a qmake variable, one per line
+function provalues()
+{
+  for PRO in $(profiles $1); do
+    sed -e 's/#.*//' -e 's/[[:space:]]*$//' $PRO |
+      sed -e ':a' -e '/\\$/N; s/\\\n/ /; ta' |
+      sed -n -E "s/^\s*$2\s*\+?=(.*)/\1/p" |
+      sed -e 's|\$\$PWD|'"$(dirname $PRO)"'|g' |
+      tr -s ' \t' '\n\n' | grep -v '^$'
+  done
+}
+
+# print every file a project is built from, following #include directives
+# through the project's own directory and its INCLUDEPATH
+function projectinputs()
+{
+  local PRO=$(realpath $(echo $SCRIPT_DIR/$1/*.pro))
+  local -a INCLUDE_DIRS=("$(dirname $PRO)" $(provalues $PRO INCLUDEPATH))
+  local -a QUEUE=($(realpath -m $(profiles $PRO) $(provalues $PRO SOURCES) $(provalues $PRO HEADERS) \
+                                 $(provalues $PRO PRECOMPILED_HEADER)))
+  local -A SEEN
+
+  while [ ${#QUEUE[@]} -gt 0 ]; do
+    local FILE=${QUEUE[0]}
+    QUEUE=("${QUEUE[@]:1}")
+    if [[ ${SEEN[$FILE]} ]] || [ ! -f "$FILE" ]; then
+      continue
+    fi
+    SEEN[$FILE]=1
+    echo $FILE
+
+    for INCLUDE in $(sed -n -E 's/^\s*#\s*include\s*[<"]([^>"]+)[>"].*/\1/p' $FILE); do
+      for DIR in "$(dirname $FILE)" "${INCLUDE_DIRS[@]}"; do
+        if [ -f "$DIR/$INCLUDE" ]; then
+          QUEUE+=("$(realpath $DIR/$INCLUDE)")
+          break
+        fi
+      done
+    done
+  done
+}
+
+# hash of everything a project is built from, including the mock library
+function inputhash()
+{
+  { projectinputs $1; projectinputs MockLibrary; } | sort -u | xargs sha1sum | sha1sum | cut -d ' ' -f 1
+}
+
+# Benchmark suites only run under the perf profile
+if [ "$PROFILE" != perf ] ; then
+    for TEST_NAME in "${!TESTS_TO_RUN[@]}"; do
+        if provalues $SCRIPT_DIR/$TEST_NAME/*.pro CONFIG | grep -qx benchmark; then
+            echo "Skipping benchmark suite $TEST_NAME (use -profile=perf)"
+            unset TESTS_TO_RUN["$TEST_NAME"]
+        fi
+    done
+fi
+
+# true when the reports a cached result stands in for are present: the
+# xunit report (in $2) with -xml and the tracefile (in $3) under the
+# coverage profile
+function hasartifacts()
+{
+  if [[ $XML_OUTPUT ]] && [ ! -f $2/$1.xml ]; then
+    return 1
+  fi
+  if [ "$PROFILE" = coverage ] && [ ! -f $3/$1.info ]; then
+    return 1
+  fi
+  return 0
+}
+
+# In incremental mode, drop projects that passed with the same inputs
+# and whose reports can be reused
+declare -A INPUT_HASH
+declare -a CACHED_TESTS
+CACHE_DIR=$SCRIPT_DIR/.testcache/$PROFILE
+if [[ $INCREMENTAL ]] ; then
+    mkdir -p $CACHE_DIR
+    for TEST_NAME in "${!TESTS_TO_RUN[@]}"; do
+        INPUT_HASH["$TEST_NAME"]=$(inputhash $TEST_NAME)
+        if [ "$(cat $CACHE_DIR/$TEST_NAME.pass 2>/dev/null)" = "${INPUT_HASH[$TEST_NAME]}" ] &&
+           hasartifacts $TEST_NAME $CACHE_DIR $CACHE_DIR; then
+            CACHED_TESTS+=("$TEST_NAME")
+            unset TESTS_TO_RUN["$TEST_NAME"]
+        fi
+    done
+fi
 
 # ensure coverage directory exists, remove any files from previous runs
-mkdir -p $SCRIPT_DIR/CodeCoverage
-rm -r $SCRIPT_DIR/CodeCoverage/*
+# (incremental runs keep the tracefiles of cached projects)
+if [ "$PROFILE" = coverage ] ; then
+    mkdir -p $SCRIPT_DIR/CodeCoverage
+    if [[ $INCREMENTAL ]] ; then
+        rm -f $SCRIPT_DIR/CodeCoverage/coverage_report.info
+        for TEST_NAME in "${!TESTS_TO_RUN[@]}"; do
+            rm -f $SCRIPT_DIR/CodeCoverage/$TEST_NAME.info
+        done
+    else
+        rm -r $SCRIPT_DIR/CodeCoverage/*
+    fi
+fi
 
-echo Beginning unit testing: "${!TESTS_TO_RUN[@]}"
+# put back the reports that were saved with each cached result
+for TEST_NAME in ${CACHED_TESTS[@]}; do
+    if [[ $XML_OUTPUT ]] ; then
+        cp $CACHE_DIR/$TEST_NAME.xml $SCRIPT_DIR/UnitTestReports/$TEST_NAME.xml
+    fi
+    if [ "$PROFILE" = coverage ] ; then
+        cp $CACHE_DIR/$TEST_NAME.info $SCRIPT_DIR/CodeCoverage/$TEST_NAME.info
+    fi
+done
+
+# background jobs cannot update our counters, so each one leaves
+# <project>.build / <project>.run marker files here when it fails
+STATUS_DIR=$(mktemp -d)
+trap 'rm -rf "$STATUS_DIR"' EXIT
+
+# split the cores between the projects that run side by side
+PROJECT_SLOTS=${#TESTS_TO_RUN[@]}
+if [ "$PROJECT_SLOTS" -gt "$MAX_JOBS" ]; then
+    PROJECT_SLOTS=$MAX_JOBS
+fi
+MAKE_JOBS=$(( $(nproc) / (PROJECT_SLOTS > 0 ? PROJECT_SLOTS : 1) ))
+if [ "$MAKE_JOBS" -lt 1 ]; then
+    MAKE_JOBS=1
+fi
+
+echo Beginning unit testing \($PROFILE\): "${!TESTS_TO_RUN[@]}"
 
 FAILURES_BUILD=0
 FAILURES_RUN=0
 
 function runtest()
 {
-  TEST_NAME=${1::-1}
+  TEST_NAME=$1
  echo XML: $XML_OUTPUT
   # go into test directory
-  cd $1 
+  cd $SCRIPT_DIR/$1
+
+  # clear failure markers left by a previous attempt, and the report of an
+  # earlier run so a stale one is never merged or reused from the cache
+  rm -f "$STATUS_DIR/$TEST_NAME.build" "$STATUS_DIR/$TEST_NAME.run"
+  rm -f $SCRIPT_DIR/UnitTestReports/$TEST_NAME.xml
 
   # create build directory (if necessary) and change to it
-  mkdir -p build
-  cd build
+  mkdir -p $BUILD_DIR
+  cd $BUILD_DIR
 
   #Remove gcda file to prevent coverage numbers from accumulating
   rm -f *.gcda
 
-  #Build project, count the number of suites that fail to build
-  qmake ../*.pro -r -spec linux-g++ CONFIG+=debug CONFIG+=declarative_debug
-  make -j8 || ((FAILURES_BUILD++))
-  
+  #Build project, record the suites that fail to build
+  qmake ../*.pro -r -spec linux-g++ $QMAKE_CONFIG
+  make -j$MAKE_JOBS || touch "$STATUS_DIR/$TEST_NAME.build"
+
   #Find the executable amidst all the build files
   EXECUTABLE=$(find . -type f -executable -print)
   echo hello $EXECUTABLE
   #echo ${EXECUTABLE[@]}
   #Run the executable
-  if [[ $XML_OUTPUT ]] ; then
+  if [ "$PROFILE" = perf ] ; then
+    # keep the benchmark results alongside the console output
+    RUN_ARGS="-o $SCRIPT_DIR/UnitTestReports/$TEST_NAME.benchmark.xml,xml -o -,txt"
+  else
+    RUN_ARGS=
+  fi
+  if [[ $SHARD ]] && [ "$PROFILE" != perf ] && ! provalues $(echo ../*.pro) CONFIG | grep -qx no_shard; then
+    runshards || touch "$STATUS_DIR/$TEST_NAME.run"
+  elif [[ $XML_OUTPUT ]] ; then
     # save XML file in reports folder with directory name as filename
-    $EXECUTABLE -xunitxml > $SCRIPT_DIR/UnitTestReports/$TEST_NAME.xml || ((FAILURES_RUN++))
+    $EXECUTABLE $RUN_ARGS -o $SCRIPT_DIR/UnitTestReports/$TEST_NAME.xml,xunitxml || touch "$STATUS_DIR/$TEST_NAME.run"
   else
-    $EXECUTABLE || ((FAILURES_RUN++))
+    $EXECUTABLE $RUN_ARGS || touch "$STATUS_DIR/$TEST_NAME.run"
+  fi
+
+  if [ "$PROFILE" != coverage ] ; then
+    cd $SCRIPT_DIR
+    return
   fi
 
   echo "************************************"
   echo Collecting Code Coverage Information
   echo "************************************"
 
-  # generate .info file
-  geninfo . -o "$SCRIPT_DIR/CodeCoverage/$TEST_NAME.info" || (
-    $2 && rm * && cd $SCRIPT_DIR && runtest "$1" false
-  )
+  # generate .info file; if that fails, rebuild once from an empty build
+  # directory (which also drops the precompiled header's .gch directory)
+  if ! geninfo . -o "$SCRIPT_DIR/CodeCoverage/$TEST_NAME.info"; then
+    if $2; then
+      cd ..
+      rm -rf $BUILD_DIR
+      runtest "$1" false
+    else
+      echo "Code coverage collection failed for $TEST_NAME"
+      touch "$STATUS_DIR/$TEST_NAME.run"
+    fi
+  fi
 
   # back to script directory
   cd $SCRIPT_DIR
 }
+
+# build the mock library every test project links against
+function buildmocks()
+{
+  cd $SCRIPT_DIR/MockLibrary
+  mkdir -p $BUILD_DIR
+  cd $BUILD_DIR
+
+  qmake ../MockLibrary.pro -r -spec linux-g++ $QMAKE_CONFIG
+  make -j$(nproc)
+  local RESULT=$?
+
+  cd $SCRIPT_DIR
+  return $RESULT
+}
+
+# run every test function / data row of $EXECUTABLE as its own process,
+# MAKE_JOBS at a time, then replay their output and merge their reports
+function runshards()
+{
+  local SHARD_DIR=$SCRIPT_DIR/UnitTestReports/shards/$TEST_NAME
+  rm -rf $SHARD_DIR
+  mkdir -p $SHARD_DIR
+
+  # "<suite> <function> [<data tag>]" becomes "<function>[:<data tag>]"
+  $EXECUTABLE -datatags > $SHARD_DIR/datatags
+  cut -d ' ' -f 2- $SHARD_DIR/datatags | sed -e 's/ /:/' > $SHARD_DIR/shards
+  local SUITE=$(head -n 1 $SHARD_DIR/datatags | cut -d ' ' -f 1)
+  local COUNT=$(wc -l < $SHARD_DIR/shards)
+  if [ "$COUNT" -eq 0 ]; then
+    echo "No test functions found in $EXECUTABLE"
+    return 1
+  fi
+
+  local INDEX=0
+  while IFS= read -r SHARD; do
+    while [ "$(jobs -rp | wc -l)" -ge "$MAKE_JOBS" ]; do
+      wait -n
+    done
+    ((INDEX++))
+    (
+      $EXECUTABLE -o $SHARD_DIR/$INDEX.txt,txt -o $SHARD_DIR/$INDEX.xml,xunitxml "$SHARD" ||
+        echo $? > $SHARD_DIR/$INDEX.failed
+    ) &
+  done < $SHARD_DIR/shards
+  wait
+
+  local -a REPORTS
+  INDEX=0
+  while IFS= read -r SHARD; do
+    ((INDEX++))
+    cat $SHARD_DIR/$INDEX.txt 2> /dev/null
+
+    # QtTest only writes the xunit file when it finishes, so a shard that
+    # crashed leaves no usable report; stand in an error for it so the
+    # function/row still shows up in the merged report
+    if ! grep -qs '<testsuite[ >]' $SHARD_DIR/$INDEX.xml; then
+      local STATUS=$(cat $SHARD_DIR/$INDEX.failed 2> /dev/null)
+      local MESSAGE="$SHARD exited with status ${STATUS:-0} without writing a report"
+      echo "FAIL!  : $SUITE::$MESSAGE"
+      shardcrashreport "$SUITE" "$SHARD" "$MESSAGE" > $SHARD_DIR/$INDEX.xml
+      if [ -z "$STATUS" ]; then
+        echo 0 > $SHARD_DIR/$INDEX.failed
+      fi
+    fi
+    REPORTS+=("$SHARD_DIR/$INDEX.xml")
+  done < $SHARD_DIR/shards
+  if [[ $XML_OUTPUT ]] ; then
+    mergeshards "${REPORTS[@]}" > $SCRIPT_DIR/UnitTestReports/$TEST_NAME.xml
+  fi
+
+  ! ls $SHARD_DIR/*.failed > /dev/null 2>&1
+}
+
+# xunit report for a shard that left none: one testcase ($2) with an error
+function shardcrashreport()
+{
+  local SUITE=$(xmlescape "$1")
+  local NAME=$(xmlescape "$2")
+  local MESSAGE=$(xmlescape "$3")
+
+  echo '<?xml version="1.0" encoding="UTF-8" ?>'
+  echo "<testsuite errors=\"1\" failures=\"0\" tests=\"1\" name=\"$SUITE\">"
+  echo "  <testcase result=\"fail\" name=\"$NAME\">"
+  echo "    <error message=\"$MESSAGE\"/>"
+  echo "  </testcase>"
+  echo "</testsuite>"
+}
+
+# escape text for use in an XML attribute value
+function xmlescape()
+{
+  echo "$1" | sed -e 's/&/\&amp;/g' -e 's/</\&lt;/g' -e 's/>/\&gt;/g' -e 's/"/\&quot;/g'
+}
+
+# combine the xunit reports of one suite's shards into a single <testsuite>.
+# Every shard runs initTestCase and cleanupTestCase; those are reported once
+# (a failing run of either wins over a passing one) and the tests, failures,
+# errors, skipped and time counters are summed over the shards, less the
+# dropped duplicates.
+function mergeshards()
+{
+  # awk stops at the first input file it cannot open
+  local -a REPORTS
+  for report in "$@"; do
+    if [ -f "$report" ]; then
+      REPORTS+=("$report")
+    fi
+  done
+
+  awk '
+    # number of times the regular expression re occurs in text
+    function occurrences(text, re,    n) {
+      n = 0
+      while (match(text, re)) {
+        n++
+        text = substr(text, RSTART + RLENGTH)
+      }
+      return n
+    }
+    function failures(block) { return occurrences(block, "<failure[^>]*(result|type)=\"(fail|xpass)\"") }
+    function errors(block)   { return occurrences(block, "<error") }
+    function skipped(block)  { return occurrences(block, "<skipped") }
+    function attribute(line, name) {
+      if (match(line, " " name "=\"[0-9.]+\"")) {
+        return substr(line, RSTART + length(name) + 3, RLENGTH - length(name) - 4)
+      }
+      return 0
+    }
+    function setattribute(name, value) {
+      sub(" " name "=\"[0-9.]+\"", " " name "=\"" value "\"", header)
+    }
+    function endcase(    name) {
+      name = ""
+      if (match(block, "[ \t]name=\"[^\"]*\"")) {
+        name = substr(block, RSTART + 7, RLENGTH - 8)
+      }
+      if (name == "initTestCase" || name == "cleanupTestCase") {
+        dropped_failures += failures(block)
+        dropped_errors += errors(block)
+        dropped_skipped += skipped(block)
+        dropped_tests++
+        bad = failures(block) + errors(block)
+        if (!(name in special) || (bad && !specialbad[name])) {
+          special[name] = block
+          specialbad[name] = bad
+        }
+      } else {
+        cases = cases block
+      }
+    }
+    FNR == 1 { state = "" }
+    /^<\?xml/ || /<\/?testsuites[ >]/ { next }
+    state == "" && /<testsuite[ >]/ {
+      if (header == "") header = $0
+      tests += attribute($0, "tests")
+      total_failures += attribute($0, "failures")
+      total_errors += attribute($0, "errors")
+      total_skipped += attribute($0, "skipped")
+      time += attribute($0, "time")
+      next
+    }
+    state == "" && /<\/testsuite>/ { next }
+    state == "" && /<properties/ {
+      if (!seenproperties) properties = properties $0 "\n"
+      if (!/\/>/ && !/<\/properties>/) state = "properties"
+      else seenproperties = 1
+      next
+    }
+    state == "properties" {
+      if (!seenproperties) properties = properties $0 "\n"
+      if (/<\/properties>/) { state = ""; seenproperties = 1 }
+      next
+    }
+    state == "" && /<testcase[ >]/ {
+      block = $0 "\n"
+      if (/\/>[[:space:]]*$/ || /<\/testcase>/) endcase()
+      else state = "testcase"
+      next
+    }
+    state == "testcase" {
+      block = block $0 "\n"
+      if (/<\/testcase>/) { state = ""; endcase() }
+      next
+    }
+    state == "" && /<system-(out|err)/ {
+      stream = /<system-out/ ? "out" : "err"
+      present[stream] = 1
+      if (/<system-(out|err)\/>/) next
+      line = $0
+      sub(".*<system-" stream ">", "", line)
+      if (sub("</system-" stream ">.*", "", line)) {
+        if (line !~ /^[[:space:]]*$/) output[stream] = output[stream] line "\n"
+      } else {
+        if (line !~ /^[[:space:]]*$/) output[stream] = output[stream] line "\n"
+        state = stream
+      }
+      next
+    }
+    state == "out" || state == "err" {
+      line = $0
+      if (sub("</system-" state ">.*", "", line)) {
+        if (line !~ /^[[:space:]]*$/) output[state] = output[state] line "\n"
+        state = ""
+      } else {
+        output[state] = output[state] line "\n"
+      }
+      next
+    }
+    END {
+      kept = 0
+      for (name in special) {
+        kept++
+        dropped_failures -= failures(special[name])
+        dropped_errors -= errors(special[name])
+        dropped_skipped -= skipped(special[name])
+      }
+      setattribute("tests", tests - (dropped_tests - kept))
+      setattribute("failures", total_failures - dropped_failures)
+      setattribute("errors", total_errors - dropped_errors)
+      setattribute("skipped", total_skipped - dropped_skipped)
+      setattribute("time", time)
+
+      print "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+      print header
+      printf "%s", properties
+      printf "%s", special["initTestCase"]
+      printf "%s", cases
+      printf "%s", special["cleanupTestCase"]
+      split("out err", streams, " ")
+      for (i = 1; i <= 2; i++) {
+        stream = streams[i]
+        if (!(stream in present)) continue
+        if (output[stream] == "") print "  <system-" stream "/>"
+        else printf "  <system-%s>\n%s  </system-%s>\n", stream, output[stream], stream
+      }
+      print "</testsuite>"
+    }
+  ' "${REPORTS[@]}"
+}
+
+# combine the per-project xunit reports into a single document
+function mergexml()
+{
+  echo '<?xml version="1.0" encoding="UTF-8" ?>'
+  echo '<testsuites>'
+  for report in "$@"; do
+    if [ -f "$report" ]; then
+      grep -v -e '^<?xml' -e '<testsuites' -e '</testsuites>' "$report"
+    fi
+  done
+  echo '</testsuites>'
+}
+
+echo "************************************"
+echo Building Mock Library
+echo "************************************"
+
+if ! buildmocks; then
+    echo "Unit testing failed! The mock library failed to build."
+    exit 1
+fi
+
 count=0
 
 for TEST_NAME in ${!TESTS_TO_RUN[@]}; do
   ((count++))
-  TEST=${TEST_NAME:-1}
-  checkFailureRun=$FAILURES_RUN
-  checkFailureBuild=$FAILURES_BUILD
-  status="($count/${#TESTS_TO_RUN[@]}) Test Finished."
+
+  # wait for a free slot before starting the next project
+  while [ "$(jobs -rp | wc -l)" -ge "$MAX_JOBS" ]; do
+    wait -n
+  done
+
   echo "Running $TEST_NAME"
-  runtest "$TEST_NAME" true
-  if [ "$FAILURES_RUN" -gt "$checkFailureRun" ]; then
-  	FAILED_RUN_TESTS[count-1]=$TEST
+  (
+    runtest "$TEST_NAME" true > "$SCRIPT_DIR/UnitTestReports/logs/$TEST_NAME.log" 2>&1
+    echo "$TEST_NAME Finished."
+  ) &
+done;
+wait
+
+count=0
+
+for TEST_NAME in ${!TESTS_TO_RUN[@]}; do
+  ((count++))
+  echo "************************************"
+  echo "($count/${#TESTS_TO_RUN[@]}) $TEST_NAME"
+  echo "************************************"
+  cat "$SCRIPT_DIR/UnitTestReports/logs/$TEST_NAME.log"
+
+  if [ -e "$STATUS_DIR/$TEST_NAME.run" ]; then
+  	((FAILURES_RUN++))
+  	FAILED_RUN_TESTS[count-1]=$TEST_NAME
+  fi
+
+  if [ -e "$STATUS_DIR/$TEST_NAME.build" ]; then
+  	((FAILURES_BUILD++))
+  	FAILED_BUILD_TESTS[count-1]=$TEST_NAME
   fi
 
-  if [ "$FAILURES_BUILD" -gt "$checkFailureBuild" ]; then
-  	FAILED_BUILD_TESTS[count-1]=$TEST
+  # remember the inputs of projects that passed and produced their reports,
+  # together with a copy of those reports
+  if [[ $INCREMENTAL ]] ; then
+    rm -f $CACHE_DIR/$TEST_NAME.pass $CACHE_DIR/$TEST_NAME.xml $CACHE_DIR/$TEST_NAME.info
+    if [ ! -e "$STATUS_DIR/$TEST_NAME.run" ] && [ ! -e "$STATUS_DIR/$TEST_NAME.build" ] &&
+       hasartifacts $TEST_NAME $SCRIPT_DIR/UnitTestReports $SCRIPT_DIR/CodeCoverage; then
+      if [[ $XML_OUTPUT ]] ; then
+        cp $SCRIPT_DIR/UnitTestReports/$TEST_NAME.xml $CACHE_DIR/$TEST_NAME.xml
+      fi
+      if [ "$PROFILE" = coverage ] ; then
+        cp $SCRIPT_DIR/CodeCoverage/$TEST_NAME.info $CACHE_DIR/$TEST_NAME.info
+      fi
+      echo ${INPUT_HASH[$TEST_NAME]} > $CACHE_DIR/$TEST_NAME.pass
+    fi
   fi
 done;
 
+for TEST_NAME in ${CACHED_TESTS[@]}; do
+  echo "$TEST_NAME: inputs unchanged, cached result: passed"
+done;
+
+# combine xml reports into one file
+if [[ $XML_OUTPUT ]] ; then
+  REPORTS=()
+  for TEST_NAME in ${!TESTS_TO_RUN[@]} ${CACHED_TESTS[@]}; do
+    REPORTS+=("$SCRIPT_DIR/UnitTestReports/$TEST_NAME.xml")
+  done
+  mergexml "${REPORTS[@]}" > $SCRIPT_DIR/UnitTestReports/UnitTestResults.xml
+fi
+
 # combine info files into one tracefile
-cd $SCRIPT_DIR/CodeCoverage
-ls | grep .info | sed -e 's/^/-a\ /' | xargs lcov -o coverage_report.info
-
-# remove unwanted files from our lcov report
-# i.e. all moc files, h files, etc
-lcov --remove coverage_report.info "moc_*" -o coverage_report.info
-lcov --remove coverage_report.info "*.h" -o coverage_report.info
-lcov --remove coverage_report.info "*.moc" -o coverage_report.info
-lcov --remove coverage_report.info "/usr/include/*" -o coverage_report.info
-
-# remove reuse code from the coverage info
-lcov --remove coverage_report.info "COTS/PbreMpCommon/*" -o coverage_report.info
-lcov --remove coverage_report.info "GOTS/FBCE/externs/src/QTUtils/*" -o coverage_report.info
-lcov --remove coverage_report.info "GOTS/IpsugGS/*" -o coverage_report.info
-lcov --remove coverage_report.info "GOTS/PbreMpCommon/*" -o coverage_report.info
-lcov --remove coverage_report.info "GOTS/PowerDNA/*" -o coverage_report.info
-
-# remove test console code from the coverage info
-lcov --remove coverage_report.info "utilities/TestConsole/*" -o coverage_report.info
-
-# remove test code from the coverage info
-# i.e. mock classes and unit test suites
-lcov --remove coverage_report.info "Testing/*" -o coverage_report.info
-
-# generate html report
-genhtml -o . coverage_report.info
-
-cd $SCRIPT_DIR
+if [ "$PROFILE" = coverage ] ; then
+    cd $SCRIPT_DIR/CodeCoverage
+    ls | grep .info | sed -e 's/^/-a\ /' | xargs lcov -o coverage_report.info
+
+    # remove unwanted files from our lcov report
+    # i.e. all moc files, h files, etc
+    lcov --remove coverage_report.info "moc_*" -o coverage_report.info
+    lcov --remove coverage_report.info "*.h" -o coverage_report.info
+    lcov --remove coverage_report.info "*.moc" -o coverage_report.info
+    lcov --remove coverage_report.info "/usr/include/*" -o coverage_report.info
+
+    # remove reuse code from the coverage info
+    lcov --remove coverage_report.info "COTS/PbreMpCommon/*" -o coverage_report.info
+    lcov --remove coverage_report.info "GOTS/FBCE/externs/src/QTUtils/*" -o coverage_report.info
+    lcov --remove coverage_report.info "GOTS/IpsugGS/*" -o coverage_report.info
+    lcov --remove coverage_report.info "GOTS/PbreMpCommon/*" -o coverage_report.info
+    lcov --remove coverage_report.info "GOTS/PowerDNA/*" -o coverage_report.info
+
+    # remove test console code from the coverage info
+    lcov --remove coverage_report.info "utilities/TestConsole/*" -o coverage_report.info
+
+    # remove test code from the coverage info
+    # i.e. mock classes and unit test suites
+    lcov --remove coverage_report.info "Testing/*" -o coverage_report.info
+
+    # generate html report
+    genhtml -o . coverage_report.info
+
+    cd $SCRIPT_DIR
+fi
 
 # print whether testing succeeded or not
 # return an error code if any tests failed to build